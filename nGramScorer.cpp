@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cmath>
 #include <sstream>
 #include <unordered_map>
@@ -24,9 +25,74 @@ nGramScorer::nGramScorer(std::ifstream file) {
     for (auto &elementPair : nGramFrequencies) {
         nGramFrequencies[elementPair.first] = log10(elementPair.second) - logSum;
     }
+    // Build the shift table for n-grams up to quadgrams (7.3 MB); larger ones fall back to the map
+    if (nGramLength < 2 || nGramLength > 4) {
+        return;
+    }
+    double floor = log10(0.01) - logSum;
+    int contextCount = (int) pow(26, nGramLength - 1);
+    shiftTable.assign((size_t) contextCount * 52, floor);
+    int tableEntries = 0;
+    for (auto &elementPair : nGramFrequencies) {
+        const std::string &ngram = elementPair.first;
+        if ((int) ngram.length() != nGramLength ||
+            !std::all_of(ngram.begin(), ngram.end(), [](char c) { return c >= 'A' && c <= 'Z'; })) {
+            continue;
+        }
+        double *row = &shiftTable[(size_t) contextIndex(ngram.data()) * 52];
+        int column = (26 - (ngram.back() - 'A')) % 26;
+        row[column] = elementPair.second;
+        row[column + 26] = elementPair.second;
+        tableEntries++;
+    }
+    // A file without valid n-grams (e.g. a Git LFS pointer) keeps using the map
+    if (tableEntries == 0) {
+        shiftTable.clear();
+    }
+}
+
+int nGramScorer::getNGramLength() const {
+    return nGramLength;
+}
+
+bool nGramScorer::hasShiftTable() const {
+    return !shiftTable.empty();
+}
+
+int nGramScorer::contextIndex(const char *context) const {
+    // Read the first n - 1 letters as a base-26 number
+    int index = 0;
+    for (int i = 0; i < nGramLength - 1; i++) {
+        index = index * 26 + (context[i] - 'A');
+    }
+    return index;
+}
+
+double nGramScorer::logProbability(int contextIndex, char letter) const {
+    int letterIndex = letter - 'A';
+    return shiftTable[(size_t) contextIndex * 52 + (26 - letterIndex) % 26];
+}
+
+void nGramScorer::scoreShifts(const int *contexts, const char *cipherLetters, const double *blockScores,
+                              int blockCount, double *shiftScores) const {
+    // shiftScores[k] is the score of every block when the last letter of each block is decrypted
+    // with shift k. Blocks are added in order, so the sums match scoring each decryption in turn.
+    // The sums are kept in a local array so that they cannot alias the table, and the 26 shifts
+    // are vectorized with -fopenmp-simd.
+    double sums[26] = {};
+    for (int b = 0; b < blockCount; b++) {
+        // Decrypting letter x with shift k gives (x - k) mod 26, which is row[(26 - x) % 26 + k]
+        const double *row = &shiftTable[(size_t) contexts[b] * 52 + (26 - (cipherLetters[b] - 'A')) % 26];
+        double blockScore = blockScores[b];
+        #pragma omp simd
+        for (int k = 0; k < 26; k++) {
+            sums[k] += blockScore + row[k];
+        }
+    }
+    std::copy(sums, sums + 26, shiftScores);
 }
 
-double nGramScorer::score(const std::string &text) {
+double nGramScorer::score(const std::string &text) const {
     double score = 0;
     double floor = log10(0.01) - log10(sumTotalOccurrence);
     // Get pointers to the start and end of the text
@@ -1,4 +1,5 @@
 #include <fstream>
+#include <vector>
 
 #ifndef NGRAMSCORER_H
 #define NGRAMSCORER_H
@@ -7,11 +8,26 @@ class nGramScorer {
 public:
     explicit nGramScorer(std::ifstream file);
 
-    double score(const std::string &text);
+    double score(const std::string &text) const;
+
+    int getNGramLength() const;
+
+    bool hasShiftTable() const;
+
+    int contextIndex(const char *context) const;
+
+    double logProbability(int contextIndex, char letter) const;
+
+    void scoreShifts(const int *contexts, const char *cipherLetters, const double *blockScores, int blockCount,
+                     double *shiftScores) const;
 
 private:
     std::unordered_map<std::string, double> nGramFrequencies;
-    int nGramLength;
+    // Dense log probabilities, one 52-entry row per (n - 1)-letter context. Each row holds the 26
+    // next-letter log probabilities in reverse order, twice over, so that the 26 shifts of a
+    // ciphertext letter read a contiguous slice of the row.
+    std::vector<double> shiftTable;
+    int nGramLength{};
     double sumTotalOccurrence{};
 };
 
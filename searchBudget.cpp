@@ -0,0 +1,167 @@
+/**
+ * @author Zehadi Alam
+ */
+
+#include <algorithm>
+#include <csignal>
+#include "searchBudget.h"
+
+/**
+ * Sets the time budget given to each attempt. A budget of zero or less disables anytime mode.
+ *
+ * @param seconds The number of seconds each attempt may run for.
+ */
+void searchBudget::setTimeBudget(double seconds) {
+    searchBudget::timeBudget = seconds;
+}
+
+/**
+ * Gets whether anytime mode is enabled.
+ *
+ * @return True if a time budget has been set.
+ */
+bool searchBudget::isEnabled() {
+    return searchBudget::timeBudget > 0;
+}
+
+/**
+ * Starts a new attempt by resetting the deadline, coverage counters, and best key. While
+ * anytime mode is enabled, an interrupt signal (Ctrl+C) cancels the attempt instead of
+ * terminating the program.
+ */
+void searchBudget::start() {
+    startTime = std::chrono::steady_clock::now();
+    deadline = startTime + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(timeBudget));
+    cancelled = false;
+    plannedCandidates = 0;
+    scoredCandidates = 0;
+    {
+        std::lock_guard<std::mutex> lock(bestMutex);
+        bestScore = 0;
+        bestKey.clear();
+    }
+    if (isEnabled()) {
+        std::signal(SIGINT, [](int) { searchBudget::cancel(); });
+    }
+}
+
+/**
+ * Ends the current attempt and restores the default interrupt signal handler.
+ */
+void searchBudget::stop() {
+    if (isEnabled()) {
+        std::signal(SIGINT, SIG_DFL);
+    }
+}
+
+/**
+ * Requests that the current attempt stop at the next cancellation check.
+ */
+void searchBudget::cancel() {
+    searchBudget::cancelled = true;
+}
+
+/**
+ * Checks whether the current attempt should stop, either because the deadline has passed or
+ * because it was cancelled.
+ *
+ * @return True if the search should stop.
+ */
+bool searchBudget::expired() {
+    if (cancelled) {
+        return true;
+    }
+    if (isEnabled() && std::chrono::steady_clock::now() >= deadline) {
+        cancelled = true;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Gets whether the last attempt was stopped before searching its whole space.
+ *
+ * @return True if the deadline was reached or the attempt was cancelled.
+ */
+bool searchBudget::wasStopped() {
+    return searchBudget::cancelled;
+}
+
+/**
+ * Adds to the number of candidate keys the current attempt plans to score.
+ *
+ * @param count The number of candidate keys.
+ */
+void searchBudget::planCandidates(long long count) {
+    searchBudget::plannedCandidates += count;
+}
+
+/**
+ * Records that candidate keys have been scored.
+ *
+ * @param count The number of candidate keys.
+ */
+void searchBudget::recordCandidate(long long count) {
+    searchBudget::scoredCandidates.fetch_add(count, std::memory_order_relaxed);
+}
+
+/**
+ * Gets the fraction of the planned candidate keys that have been scored.
+ *
+ * @return A value between 0 and 1.
+ */
+double searchBudget::coverage() {
+    long long planned = plannedCandidates;
+    if (planned == 0) {
+        return 0;
+    }
+    return std::min(1.0, (double) scoredCandidates / (double) planned);
+}
+
+/**
+ * Gets the number of seconds since the current attempt was started.
+ *
+ * @return The elapsed time in seconds.
+ */
+double searchBudget::elapsedSeconds() {
+    std::chrono::duration<double> elapsedTime = std::chrono::steady_clock::now() - startTime;
+    return elapsedTime.count();
+}
+
+/**
+ * Offers a scored key as the best key found so far.
+ *
+ * @param score The n-gram score of the plaintext decrypted with the key.
+ * @param key The key.
+ * @return True if the key improves on the best key found so far.
+ */
+bool searchBudget::offerResult(double score, const std::string &key) {
+    std::lock_guard<std::mutex> lock(bestMutex);
+    if (!bestKey.empty() && score <= bestScore) {
+        return false;
+    }
+    bestScore = score;
+    bestKey = key;
+    return true;
+}
+
+/**
+ * Gets the best key found so far in the current attempt.
+ *
+ * @return The best key, or an empty string if no key has been scored.
+ */
+std::string searchBudget::getBestKey() {
+    std::lock_guard<std::mutex> lock(bestMutex);
+    return bestKey;
+}
+
+/**
+ * Gets the score of the best key found so far in the current attempt.
+ *
+ * @return The best score.
+ */
+double searchBudget::getBestScore() {
+    std::lock_guard<std::mutex> lock(bestMutex);
+    return bestScore;
+}
@@ -0,0 +1,137 @@
+/**
+ * @file searchBudget.h
+ *
+ * @brief Header file for the time budget used by the anytime search mode.
+ *
+ * @author Zehadi Alam
+ */
+
+#ifndef SEARCHBUDGET_H
+#define SEARCHBUDGET_H
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+
+/**
+ * @class searchBudget
+ *
+ * @brief Utility class for bounding the latency of a key search.
+ *
+ * This class provides static methods for setting a time budget, checking whether the search
+ * should stop, tracking how much of the search space has been covered, and keeping the best
+ * key found so far. The candidate loops poll expired() and stop early when it returns true.
+ */
+class searchBudget {
+public:
+   /**
+    * Sets the time budget given to each attempt. A budget of zero or less disables anytime mode.
+    *
+    * @param seconds The number of seconds each attempt may run for.
+    */
+    static void setTimeBudget(double seconds);
+
+   /**
+    * Gets whether anytime mode is enabled.
+    *
+    * @return True if a time budget has been set.
+    */
+    static bool isEnabled();
+
+   /**
+    * Starts a new attempt by resetting the deadline, coverage counters, and best key. While
+    * anytime mode is enabled, an interrupt signal (Ctrl+C) cancels the attempt instead of
+    * terminating the program.
+    */
+    static void start();
+
+   /**
+    * Ends the current attempt and restores the default interrupt signal handler.
+    */
+    static void stop();
+
+   /**
+    * Requests that the current attempt stop at the next cancellation check.
+    */
+    static void cancel();
+
+   /**
+    * Checks whether the current attempt should stop, either because the deadline has passed or
+    * because it was cancelled.
+    *
+    * @return True if the search should stop.
+    */
+    static bool expired();
+
+   /**
+    * Gets whether the last attempt was stopped before searching its whole space.
+    *
+    * @return True if the deadline was reached or the attempt was cancelled.
+    */
+    static bool wasStopped();
+
+   /**
+    * Adds to the number of candidate keys the current attempt plans to score.
+    *
+    * @param count The number of candidate keys.
+    */
+    static void planCandidates(long long count);
+
+   /**
+    * Records that candidate keys have been scored.
+    *
+    * @param count The number of candidate keys.
+    */
+    static void recordCandidate(long long count = 1);
+
+   /**
+    * Gets the fraction of the planned candidate keys that have been scored.
+    *
+    * @return A value between 0 and 1.
+    */
+    static double coverage();
+
+   /**
+    * Gets the number of seconds since the current attempt was started.
+    *
+    * @return The elapsed time in seconds.
+    */
+    static double elapsedSeconds();
+
+   /**
+    * Offers a scored key as the best key found so far.
+    *
+    * @param score The n-gram score of the plaintext decrypted with the key.
+    * @param key The key.
+    * @return True if the key improves on the best key found so far.
+    */
+    static bool offerResult(double score, const std::string &key);
+
+   /**
+    * Gets the best key found so far in the current attempt.
+    *
+    * @return The best key, or an empty string if no key has been scored.
+    */
+    static std::string getBestKey();
+
+   /**
+    * Gets the score of the best key found so far in the current attempt.
+    *
+    * @return The best score.
+    */
+    static double getBestScore();
+
+private:
+    inline static double timeBudget;
+    inline static std::chrono::steady_clock::time_point startTime;
+    inline static std::chrono::steady_clock::time_point deadline;
+    inline static std::atomic<bool> cancelled;
+    inline static std::atomic<long long> plannedCandidates;
+    inline static std::atomic<long long> scoredCandidates;
+    inline static std::mutex bestMutex;
+    inline static double bestScore;
+    inline static std::string bestKey;
+};
+
+#endif // SEARCHBUDGET_H
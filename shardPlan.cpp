@@ -0,0 +1,149 @@
+/**
+ * @author Zehadi Alam
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include "shardPlan.h"
+
+/**
+ * Constructs the plan for a given ciphertext.
+ *
+ * @param ciphertext The formatted ciphertext being searched.
+ * @param rangeStart The minimum key length to try.
+ * @param rangeEnd The maximum key length to try.
+ * @param n The number of characters making up the key prefix.
+ * @param slices The number of slices each key length's prefix candidates are split into.
+ */
+shardPlan::shardPlan(const std::string &ciphertext, int rangeStart, int rangeEnd, int n, int slices)
+        : rangeStart(rangeStart), rangeEnd(rangeEnd), n(n) {
+    // FNV-1a hash, so that result files are tied to the ciphertext they were computed for
+    ciphertextHash = 14695981039346656037ULL;
+    for (char c : ciphertext) {
+        ciphertextHash ^= (unsigned char) c;
+        ciphertextHash *= 1099511628211ULL;
+    }
+    prefixCount = (int) pow(26, n);
+    // Every slice must contain at least one prefix
+    shardPlan::slices = std::clamp(slices, 1, prefixCount);
+}
+
+/**
+ * Gets the total number of work units in the plan.
+ *
+ * @return The number of work units.
+ */
+int shardPlan::getUnitCount() const {
+    return std::max(0, rangeEnd - rangeStart + 1) * slices;
+}
+
+/**
+ * Gets the key length searched by a work unit.
+ *
+ * @param unit The work unit.
+ * @return The key length.
+ */
+int shardPlan::getKeyLength(int unit) const {
+    return rangeStart + unit / slices;
+}
+
+/**
+ * Gets the first prefix permutation index searched by a work unit.
+ *
+ * @param unit The work unit.
+ * @return The first prefix permutation index (inclusive).
+ */
+int shardPlan::getPrefixStart(int unit) const {
+    return (int) ((long long) prefixCount * (unit % slices) / slices);
+}
+
+/**
+ * Gets the end of the prefix permutation indices searched by a work unit.
+ *
+ * @param unit The work unit.
+ * @return The last prefix permutation index (exclusive).
+ */
+int shardPlan::getPrefixEnd(int unit) const {
+    return (int) ((long long) prefixCount * (unit % slices + 1) / slices);
+}
+
+/**
+ * Checks whether a work unit is assigned to a worker.
+ *
+ * @param unit The work unit.
+ * @param workerIndex The index of the worker, from 0 to workers - 1.
+ * @param workers The total number of workers.
+ * @return True if the worker owns the work unit.
+ */
+bool shardPlan::isAssigned(int unit, int workerIndex, int workers) {
+    return unit % workers == workerIndex;
+}
+
+/**
+ * Writes a worker's partial results to a file.
+ *
+ * @param path The file to write.
+ * @param results The results to write.
+ * @return True if the file was written successfully.
+ */
+bool shardPlan::writeResults(const std::string &path, const std::vector<shardResult> &results) const {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+    file << header() << "\n";
+    char score[32];
+    for (const shardResult &result : results) {
+        // 17 significant digits round-trip a double exactly, so merged scores match a single run
+        snprintf(score, sizeof(score), "%.17g", result.score);
+        file << result.unit << " " << result.prefixIndex << " " << score << "\n";
+    }
+    file.close();
+    return !file.fail();
+}
+
+/**
+ * Reads a worker's partial results from a file, appending them to the given results.
+ *
+ * @param path The file to read.
+ * @param results The results to append to.
+ * @return True if the file was read successfully and was written for this plan.
+ */
+bool shardPlan::readResults(const std::string &path, std::vector<shardResult> &results) const {
+    std::ifstream file(path);
+    std::string line{};
+    if (!file.is_open() || !getline(file, line) || line != header()) {
+        return false;
+    }
+    while (getline(file, line)) {
+        std::stringstream lineStream(line);
+        shardResult result{};
+        std::string score;
+        if (!(lineStream >> result.unit >> result.prefixIndex >> score)) {
+            return false;
+        }
+        result.score = std::strtod(score.c_str(), nullptr);
+        if (result.unit < 0 || result.unit >= getUnitCount() || result.prefixIndex < getPrefixStart(result.unit) ||
+            result.prefixIndex >= getPrefixEnd(result.unit)) {
+            return false;
+        }
+        results.push_back(result);
+    }
+    return true;
+}
+
+/**
+ * Returns the header line that identifies the plan in result files.
+ *
+ * @return The header line.
+ */
+std::string shardPlan::header() const {
+    std::ostringstream headerStream;
+    headerStream << "vigenereCipherBreaker-shard " << std::hex << ciphertextHash << std::dec << " " << rangeStart
+                 << " " << rangeEnd << " " << n << " " << slices;
+    return headerStream.str();
+}
@@ -0,0 +1,125 @@
+/**
+ * @file shardPlan.h
+ *
+ * @brief Header file for the sharded key search plan.
+ *
+ * @author Zehadi Alam
+ */
+
+#ifndef SHARDPLAN_H
+#define SHARDPLAN_H
+
+#include <string>
+#include <vector>
+
+/**
+ * @struct shardResult
+ *
+ * @brief A scored key prefix found by a shard worker.
+ */
+struct shardResult {
+    int unit;
+    int prefixIndex;
+    double score;
+};
+
+/**
+ * @class shardPlan
+ *
+ * @brief Deterministic partition of a key search into work units.
+ *
+ * Each key length in the range is split into a fixed number of slices of the key prefix
+ * candidate space, and each (key length, slice) pair is a work unit. Work units are assigned to
+ * workers round-robin, so any process given the same ciphertext and plan parameters agrees on
+ * which units it owns. This class also reads and writes the partial result files that workers
+ * produce, checking that they belong to the same plan.
+ */
+class shardPlan {
+public:
+   /**
+    * Constructs the plan for a given ciphertext.
+    *
+    * @param ciphertext The formatted ciphertext being searched.
+    * @param rangeStart The minimum key length to try.
+    * @param rangeEnd The maximum key length to try.
+    * @param n The number of characters making up the key prefix.
+    * @param slices The number of slices each key length's prefix candidates are split into.
+    */
+    shardPlan(const std::string &ciphertext, int rangeStart, int rangeEnd, int n, int slices);
+
+   /**
+    * Gets the total number of work units in the plan.
+    *
+    * @return The number of work units.
+    */
+    int getUnitCount() const;
+
+   /**
+    * Gets the key length searched by a work unit.
+    *
+    * @param unit The work unit.
+    * @return The key length.
+    */
+    int getKeyLength(int unit) const;
+
+   /**
+    * Gets the first prefix permutation index searched by a work unit.
+    *
+    * @param unit The work unit.
+    * @return The first prefix permutation index (inclusive).
+    */
+    int getPrefixStart(int unit) const;
+
+   /**
+    * Gets the end of the prefix permutation indices searched by a work unit.
+    *
+    * @param unit The work unit.
+    * @return The last prefix permutation index (exclusive).
+    */
+    int getPrefixEnd(int unit) const;
+
+   /**
+    * Checks whether a work unit is assigned to a worker.
+    *
+    * @param unit The work unit.
+    * @param workerIndex The index of the worker, from 0 to workers - 1.
+    * @param workers The total number of workers.
+    * @return True if the worker owns the work unit.
+    */
+    static bool isAssigned(int unit, int workerIndex, int workers);
+
+   /**
+    * Writes a worker's partial results to a file.
+    *
+    * @param path The file to write.
+    * @param results The results to write.
+    * @return True if the file was written successfully.
+    */
+    bool writeResults(const std::string &path, const std::vector<shardResult> &results) const;
+
+   /**
+    * Reads a worker's partial results from a file, appending them to the given results.
+    *
+    * @param path The file to read.
+    * @param results The results to append to.
+    * @return True if the file was read successfully and was written for this plan.
+    */
+    bool readResults(const std::string &path, std::vector<shardResult> &results) const;
+
+private:
+   /**
+    * Returns the header line that identifies the plan in result files.
+    *
+    * @return The header line.
+    */
+    std::string header() const;
+
+    unsigned long long ciphertextHash;
+    int rangeStart;
+    int rangeEnd;
+    int n;
+    int slices;
+    int prefixCount;
+};
+
+#endif // SHARDPLAN_H
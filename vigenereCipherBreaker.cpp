@@ -1,12 +1,18 @@
 #include <chrono>
 #include <cstring>
+#include <filesystem>
 #include <functional>
 #include <iomanip>
 #include <iostream>
 #include <map>
+#include <sstream>
 #include <thread>
 #include <valarray>
+#include <sys/wait.h>
+#include <unistd.h>
 #include "nGramScorer.h"
+#include "searchBudget.h"
+#include "shardPlan.h"
 #include "vigenereCipher.h"
 
 using std::string;
@@ -89,6 +95,30 @@ string ngramPermutation(int n, int permutationCount, string alphabet) {
     return ngram;
 }
 
+/**
+ * Return the score of a particular n-letter key prefix
+ * @param ngram a particular nGramScorer object
+ * @param n the number of characters making up the ngram
+ * @param alphabet the English alphabet
+ * @param ciphertext the ciphertext to be decrypted
+ * @param keyLength the number of characters of the key
+ * @param permutationIndex the permutation count of the key prefix, as used by ngramPermutation()
+ * @return the score of the key prefix
+ */
+double prefixScore(const nGramScorer &ngram, int n, const string &alphabet, const string &ciphertext, int keyLength,
+                   int permutationIndex) {
+    string key = ngramPermutation(n, permutationIndex, alphabet) + string(keyLength - n, 'A');
+    string formattedKey = vigenereCipher::formatKey(ciphertext, key);
+    string plaintext = vigenereCipher::decrypt(ciphertext, formattedKey);
+    double score = 0;
+    for (int j = 0; j < (int) ciphertext.length(); j += keyLength) {
+        if (j + n < (int) plaintext.length()) {
+            score += ngram.score(plaintext.substr(j, n));
+        }
+    }
+    return score;
+}
+
 /**
  * Return the first n letters of the potential decryption key
  * @param ngram a particular nGramScorer object
@@ -98,31 +128,124 @@ string ngramPermutation(int n, int permutationCount, string alphabet) {
  * @param keyLength the number of characters of the key
  * @return the first n letters of the potential decryption key
  */
-string firstNKeyLetters(nGramScorer ngram, int n, const string &alphabet, const string &ciphertext, int keyLength) {
+string firstNKeyLetters(const nGramScorer &ngram, int n, const string &alphabet, const string &ciphertext, int keyLength) {
     std::vector<std::pair<double, string>> keyCandidates;
     keyCandidates.reserve(17576); // preallocate elements
-    string pad(keyLength - n, 'A');
     int totalngramPermutations = pow(26, n);
     for (int i = 0; i < totalngramPermutations; i++) {
-        string key = ngramPermutation(n, i, alphabet) + pad;
-        string formattedKey = vigenereCipher::formatKey(ciphertext, key);
-        string plaintext = vigenereCipher::decrypt(ciphertext, formattedKey);
-        double score = 0;
-        for (int j = 0; j < (int) ciphertext.length(); j += keyLength) {
-            if (j + n < (int) plaintext.length()) {
-                score += ngram.score(plaintext.substr(j, n));
-            }
+        double score = prefixScore(ngram, n, alphabet, ciphertext, keyLength, i);
+        keyCandidates.push_back(std::make_pair(score, ngramPermutation(n, i, alphabet)));
+        searchBudget::recordCandidate();
+        if (searchBudget::expired()) {
+            break;
         }
-        keyCandidates.push_back(std::make_pair(score, key.substr(0, n)));
     }
-    // Sort key candidates by score in ascending order
-    std::sort(keyCandidates.begin(), keyCandidates.end(),
+    // Sort key candidates by score in descending order. Ties keep the lowest permutation so that
+    // sharded searches pick the same prefix.
+    std::stable_sort(keyCandidates.begin(), keyCandidates.end(),
         [](const std::pair<double, string>& a, const std::pair<double, string>& b) {
             return a.first > b.first;
         });
     return keyCandidates[0].second;
 }
 
+/**
+ * Prints a key that improves on the best key found so far in anytime mode
+ * @param bestScore the score of the improved key
+ * @param tryKey the improved key
+ */
+void printProgress(double bestScore, const string &tryKey) {
+    std::ostringstream progress;
+    progress << std::fixed << std::setprecision(2) << "[" << searchBudget::elapsedSeconds() << "s, "
+             << searchBudget::coverage() * 100 << "% searched] " << "New best key: " << tryKey
+             << " (length " << tryKey.length() << ", score " << std::setprecision(4) << bestScore << ")\n";
+    cout << progress.str() << std::flush;
+}
+
+/**
+ * Offers the key builder, padded with 'A' to the full key length, as the best key found so far in
+ * anytime mode, so that keys improve while a single key length is still being searched
+ * @param ngram the nGramScorer object used to score full keys
+ * @param ciphertext the ciphertext to be decrypted
+ * @param keyLength the number of characters of the key
+ * @param keyBuilder the letters of the key found so far
+ */
+void offerKeyBuilder(const nGramScorer &ngram, const string &ciphertext, int keyLength, const string &keyBuilder) {
+    if (!searchBudget::isEnabled()) {
+        return;
+    }
+    string key = keyBuilder + string(keyLength - keyBuilder.length(), 'A');
+    double score = ngram.score(vigenereCipher::decrypt(ciphertext, vigenereCipher::formatKey(ciphertext, key)));
+    if (searchBudget::offerResult(score, key)) {
+        printProgress(score, key);
+    }
+}
+
+/**
+ * Decrypts the ciphertext with the key builder and scores the start of each key-length block of
+ * the plaintext, up to the end of the key builder, for use by scoreKeyLetters()
+ * @param ngram a particular nGramScorer object
+ * @param ciphertext the ciphertext to be decrypted
+ * @param keyLength the number of characters of the key
+ * @param keyBuilder the letters of the key found so far
+ * @param plaintext set to the ciphertext decrypted with the key builder
+ * @param blockScores set to the score of each block of the plaintext
+ */
+void startKeyLetterScores(const nGramScorer &ngram, const string &ciphertext, int keyLength, const string &keyBuilder,
+                          string &plaintext, std::vector<double> &blockScores) {
+    string fullKey = keyBuilder + string(keyLength - keyBuilder.length(), 'A');
+    plaintext = vigenereCipher::decrypt(ciphertext, vigenereCipher::formatKey(ciphertext, fullKey));
+    blockScores.clear();
+    for (int j = 0; j < (int) ciphertext.length(); j += keyLength) {
+        blockScores.push_back(ngram.score(plaintext.substr(j, keyBuilder.length())));
+    }
+}
+
+/**
+ * Scores every letter of the alphabet at the next position of the key in one pass over the
+ * ciphertext column at that position. Only the last n-gram of each block depends on the letter,
+ * so each score is the same as decrypting the ciphertext with the extended key and scoring each
+ * block, as the letter-by-letter loop in fullKeyNormal() does.
+ * @param ngram a particular nGramScorer object with a shift table
+ * @param ciphertext the ciphertext to be decrypted
+ * @param keyLength the number of characters of the key
+ * @param plaintext the ciphertext decrypted with the key builder
+ * @param blockScores the score of each block of the plaintext up to the end of the key builder
+ * @param position the position of the next key letter, which must be at least the ngram length - 1
+ * @param shiftScores set to the score of each letter of the alphabet at the position
+ */
+void scoreKeyLetters(const nGramScorer &ngram, const string &ciphertext, int keyLength, const string &plaintext,
+                     const std::vector<double> &blockScores, int position, double shiftScores[26]) {
+    int contextStart = position + 1 - ngram.getNGramLength();
+    std::vector<int> contexts;
+    std::vector<char> cipherLetters;
+    for (int j = 0; j + position + 1 < (int) ciphertext.length(); j += keyLength) {
+        contexts.push_back(ngram.contextIndex(&plaintext[j + contextStart]));
+        cipherLetters.push_back(ciphertext[j + position]);
+    }
+    ngram.scoreShifts(contexts.data(), cipherLetters.data(), blockScores.data(), (int) contexts.size(), shiftScores);
+}
+
+/**
+ * Appends a letter to the key builder's plaintext and block scores after scoreKeyLetters()
+ * @param ngram a particular nGramScorer object with a shift table
+ * @param ciphertext the ciphertext to be decrypted
+ * @param keyLength the number of characters of the key
+ * @param plaintext the ciphertext decrypted with the key builder
+ * @param blockScores the score of each block of the plaintext up to the end of the key builder
+ * @param position the position of the key letter
+ * @param letter the key letter
+ */
+void appendKeyLetter(const nGramScorer &ngram, const string &ciphertext, int keyLength, string &plaintext,
+                     std::vector<double> &blockScores, int position, char letter) {
+    int contextStart = position + 1 - ngram.getNGramLength();
+    for (int j = 0, block = 0; j + position < (int) ciphertext.length(); j += keyLength, block++) {
+        plaintext[j + position] = (char) ((ciphertext[j + position] - letter + 26) % 26 + 'A');
+        blockScores[block] += ngram.logProbability(ngram.contextIndex(&plaintext[j + contextStart]),
+                                                   plaintext[j + position]);
+    }
+}
+
 /**
  * Return the full potential decryption key
  * @param ngram a particular nGramScorer object
@@ -131,17 +254,36 @@ string firstNKeyLetters(nGramScorer ngram, int n, const string &alphabet, const
  * @param ciphertext the ciphertext to be decrypted
  * @param keyLength the number of characters of the key
  * @param keyBuilder the result of the firstNKeyLetters() function
+ * @param batched whether to score all letters of a key position at once with scoreKeyLetters()
+ * when the ngram has a shift table
  * @return the full potential decryption key
  */
 string
-fullKeyNormal(nGramScorer ngram, int n, const string &alphabet, const string &ciphertext, int keyLength,
-              string keyBuilder) {
+fullKeyNormal(const nGramScorer &ngram, int n, const string &alphabet, const string &ciphertext, int keyLength,
+              string keyBuilder, bool batched = true) {
     // Create a vector to store key candidates
     std::vector<std::pair<double, string>> keyCandidates;
     // Reserve space for 26 key candidates
     keyCandidates.reserve(26);
+    string plaintext{};
+    std::vector<double> blockScores;
+    batched = batched && ngram.hasShiftTable() && (int) keyBuilder.length() + 1 >= ngram.getNGramLength();
+    if (batched) {
+        startKeyLetterScores(ngram, ciphertext, keyLength, keyBuilder, plaintext, blockScores);
+    }
     // Iterate through all possible characters for the next position in the key
-    for (int i = 0; i < keyLength - n; i++) {
+    for (int i = 0; i < keyLength - n && !searchBudget::expired(); i++) {
+        if (batched) {
+            // Score every character for the next position at once and keep the first best one
+            double shiftScores[26];
+            scoreKeyLetters(ngram, ciphertext, keyLength, plaintext, blockScores, keyBuilder.length(), shiftScores);
+            char c = alphabet[std::max_element(shiftScores, shiftScores + 26) - shiftScores];
+            appendKeyLetter(ngram, ciphertext, keyLength, plaintext, blockScores, keyBuilder.length(), c);
+            keyBuilder += c;
+            searchBudget::recordCandidate(26);
+            offerKeyBuilder(ngram, ciphertext, keyLength, keyBuilder);
+            continue;
+        }
         // Clear the key candidates vector because alphabet iteration is restarted
         // for the next character in the next position in the key
         keyCandidates.clear();
@@ -172,18 +314,24 @@ fullKeyNormal(nGramScorer ngram, int n, const string &alphabet, const string &ci
             }
             // Add the score and partial key to the key candidates vector
             keyCandidates.push_back(std::make_pair(score, partialKey));
+            searchBudget::recordCandidate();
+            if (searchBudget::expired()) {
+                break;
+            }
         }
-        // Sort the key candidates by score in descending order
-        std::sort(keyCandidates.begin(), keyCandidates.end(),
+        // Sort the key candidates by score in descending order. Ties keep the first character,
+        // as the batched scoring above does.
+        std::stable_sort(keyCandidates.begin(), keyCandidates.end(),
         [](const std::pair<double, string>& a, const std::pair<double, string>& b) {
             return a.first > b.first;
         });
         // cout << keyCandidates[0].second << std::endl;
         // Set the key builder to the best candidate from the current iteration
         keyBuilder = keyCandidates[0].second;
+        offerKeyBuilder(ngram, ciphertext, keyLength, keyBuilder);
     }
-    // Return the highest scoring key candidate
-    return keyCandidates[0].second;
+    // Return the highest scoring key candidate, padded with 'A' if the search was stopped early
+    return keyBuilder + string(keyLength - keyBuilder.length(), 'A');
 }
 
 /**
@@ -194,13 +342,15 @@ fullKeyNormal(nGramScorer ngram, int n, const string &alphabet, const string &ci
  * @param ciphertext the ciphertext to be decrypted
  * @param keyLength the number of characters of the key
  * @param keyBuilder the result of the firstNKeyLetters() function
+ * @param batched whether to score all letters of a key position at once with scoreKeyLetters()
+ * when the ngram has a shift table
  * @return the full potential decryption key in a stronger deciphering attempt
  */
 string
-fullKeyStronger(nGramScorer ngram, int n, const string &alphabet, const string &ciphertext, int keyLength,
-                string keyBuilder) {
+fullKeyStronger(const nGramScorer &ngram, int n, const string &alphabet, const string &ciphertext, int keyLength,
+                string keyBuilder, bool batched = true) {
     std::map<double, string> keyCandidates;
-    for (int i = 0; i < (int) (keyLength / 3) - n; i++) {
+    for (int i = 0; i < (int) (keyLength / 3) - n && !searchBudget::expired(); i++) {
         keyCandidates.clear();
         for (int j = 0; j < (int) pow(26, 3); j++) {
             string partialKey = keyBuilder + ngramPermutation(3, j, alphabet);
@@ -215,11 +365,36 @@ fullKeyStronger(nGramScorer ngram, int n, const string &alphabet, const string &
                 }
             }
             keyCandidates[score] = partialKey;
+            searchBudget::recordCandidate();
+            if (searchBudget::expired()) {
+                break;
+            }
         }
         // cout << keyCandidates[keyCandidates.rbegin()->first] << endl;
         keyBuilder = keyCandidates[keyCandidates.rbegin()->first];
+        offerKeyBuilder(ngram, ciphertext, keyLength, keyBuilder);
+    }
+    string plaintext{};
+    std::vector<double> blockScores;
+    batched = batched && ngram.hasShiftTable() && (int) keyBuilder.length() + 1 >= ngram.getNGramLength();
+    if (batched) {
+        startKeyLetterScores(ngram, ciphertext, keyLength, keyBuilder, plaintext, blockScores);
     }
-    for (int i = (int) keyBuilder.length(); i < keyLength; i++) {
+    for (int i = (int) keyBuilder.length(); i < keyLength && !searchBudget::expired(); i++) {
+        if (batched) {
+            // Keep the last best letter, as the candidate map below does for equal scores
+            double shiftScores[26];
+            scoreKeyLetters(ngram, ciphertext, keyLength, plaintext, blockScores, i, shiftScores);
+            int best = 0;
+            for (int k = 1; k < 26; k++) {
+                best = shiftScores[k] >= shiftScores[best] ? k : best;
+            }
+            appendKeyLetter(ngram, ciphertext, keyLength, plaintext, blockScores, i, alphabet[best]);
+            keyBuilder += alphabet[best];
+            searchBudget::recordCandidate(26);
+            offerKeyBuilder(ngram, ciphertext, keyLength, keyBuilder);
+            continue;
+        }
         keyCandidates.clear();
         for (char c : alphabet) {
             string partialKey = keyBuilder + c;
@@ -234,11 +409,16 @@ fullKeyStronger(nGramScorer ngram, int n, const string &alphabet, const string &
                 }
             }
             keyCandidates[score] = partialKey;
+            searchBudget::recordCandidate();
+            if (searchBudget::expired()) {
+                break;
+            }
         }
         // cout << keyCandidates[keyCandidates.rbegin()->first] << endl;
         keyBuilder = keyCandidates[keyCandidates.rbegin()->first];
+        offerKeyBuilder(ngram, ciphertext, keyLength, keyBuilder);
     }
-    return keyCandidates[keyCandidates.rbegin()->first];
+    return keyBuilder + string(keyLength - keyBuilder.length(), 'A');
 }
 
 /**
@@ -280,6 +460,64 @@ printResults(int keyLength, const string &key, const string &originalCipherText,
          << "\n\n";
 }
 
+/**
+ * Prints the best key found by an attempt in anytime mode, along with how much of the search
+ * space was covered before the attempt finished or was stopped
+ * @param originalCipherText the ciphertext with spaces, punctuation, and non-alphabetic characters
+ * @param formattedCipherText all-caps ciphertext with spaces and punctuation removed
+ */
+void printAnytimeResults(const string &originalCipherText, const string &formattedCipherText) {
+    string key = searchBudget::getBestKey();
+    cout << "\n" << (searchBudget::wasStopped() ? "SEARCH STOPPED" : "SEARCH COMPLETED") << " AFTER "
+         << std::fixed << std::setprecision(2) << searchBudget::elapsedSeconds() << " SECONDS ("
+         << searchBudget::coverage() * 100 << "% OF SEARCH SPACE COVERED)\n\n";
+    cout.unsetf(std::ios_base::floatfield);
+    if (key.empty()) {
+        cout << "NO KEY WAS SCORED WITHIN THE TIME BUDGET\n\n";
+        return;
+    }
+    vigenereCipher::setKeyLength((int) key.length());
+    printResults((int) key.length(), key, originalCipherText, formattedCipherText);
+}
+
+/**
+ * Return the number of candidate keys scored when trying a particular key length
+ * @param n the number of characters making up the ngram
+ * @param keyLength the number of characters of the key
+ * @param stronger whether fullKeyStronger() is used to complete the key
+ * @return the number of candidate keys scored for the key length
+ */
+long long searchSpaceSize(int n, int keyLength, bool stronger) {
+    long long size = (long long) pow(26, n);
+    int keyBuilderLength = n;
+    if (stronger) {
+        int tripletSteps = std::max(0, keyLength / 3 - n);
+        size += (long long) tripletSteps * (long long) pow(26, 3);
+        keyBuilderLength += 3 * tripletSteps;
+    }
+    return size + (long long) std::max(0, keyLength - keyBuilderLength) * 26;
+}
+
+/**
+ * Records the highest scoring key as the key length to use in later attempts and prints it when
+ * verbose mode is off. Ties keep the shortest key.
+ * @param keyCandidates the scored keys, one for each key length tried in ascending order
+ * @param originalCipherText the ciphertext with spaces, punctuation, and non-alphabetic characters
+ * @param formattedCipherText all-caps ciphertext with spaces and punctuation removed
+ * @param verboseMode specify whether or not verbose mode is used
+ */
+void reportBestKey(std::vector<std::pair<double, string>> keyCandidates, const string &originalCipherText,
+                   const string &formattedCipherText, bool verboseMode) {
+    std::stable_sort(keyCandidates.begin(), keyCandidates.end(),
+        [](const std::pair<double, string>& a, const std::pair<double, string>& b) {
+            return a.first > b.first;
+        });
+    string key = keyCandidates[0].second;
+    int keyLength = key.length();
+    vigenereCipher::setKeyLength(keyLength);
+    verboseMode ? (void)0 : printResults(keyLength, key, originalCipherText, formattedCipherText);
+}
+
 /**
  * Constructs a key based on ngram scoring to potentially decrypt the message
  * @param n1 an nGramScorer object
@@ -294,30 +532,34 @@ printResults(int keyLength, const string &key, const string &originalCipherText,
  * @param verboseMode specify whether or not to use verbose mode
  */
 void
-breakEncryption(const nGramScorer &n1, nGramScorer n2, int n, int rangeStart, int rangeEnd, const string &alphabet,
+breakEncryption(const nGramScorer &n1, const nGramScorer &n2, int n, int rangeStart, int rangeEnd, const string &alphabet,
                 const string &originalCipherText, const string &formattedCipherText, bool verboseMode, bool aggressive,
                 bool accommodateShortKey, bool multithread) {
     std::vector<std::pair<double, string>> keyCandidates;
     int increment = (multithread) ? 3 : 1;
+    bool stronger = aggressive && !accommodateShortKey;
     for (int i = rangeStart; i <= rangeEnd; i += increment) {
+        searchBudget::planCandidates(searchSpaceSize(n, i, stronger));
+    }
+    for (int i = rangeStart; i <= rangeEnd && !searchBudget::expired(); i += increment) {
         int tryKeyLength = i; // Need to fix keylength. Only works with length greater than 4.
         string keyBuilder = firstNKeyLetters(n1, n, alphabet, formattedCipherText, tryKeyLength);
         string tryKey{};
-        tryKey = aggressive && !accommodateShortKey ? fullKeyStronger(n2, n, alphabet, formattedCipherText, tryKeyLength, keyBuilder) : 
+        tryKey = stronger ? fullKeyStronger(n2, n, alphabet, formattedCipherText, tryKeyLength, keyBuilder) : 
                                                       fullKeyNormal(n2, n, alphabet, formattedCipherText, tryKeyLength, keyBuilder);
         double bestScore = n2.score(
                 vigenereCipher::decrypt(formattedCipherText, vigenereCipher::formatKey(formattedCipherText, tryKey)));
         keyCandidates.push_back(std::make_pair(bestScore, tryKey));
         verboseMode ? printVerboseResults(bestScore, tryKeyLength, tryKey, originalCipherText, formattedCipherText) : (void)0;
+        if (searchBudget::isEnabled() && searchBudget::offerResult(bestScore, tryKey)) {
+            printProgress(bestScore, tryKey);
+        }
     }
-    std::sort(keyCandidates.begin(), keyCandidates.end(),
-        [](const std::pair<double, string>& a, const std::pair<double, string>& b) {
-            return a.first > b.first;
-        });
-    string key = keyCandidates[0].second;
-    int keyLength = key.length();
-    vigenereCipher::setKeyLength(keyLength);
-    verboseMode ? (void)0 : printResults(keyLength, key, originalCipherText, formattedCipherText);
+    // In anytime mode the best key across all threads is reported by printAnytimeResults()
+    if (searchBudget::isEnabled() || keyCandidates.empty()) {
+        return;
+    }
+    reportBestKey(keyCandidates, originalCipherText, formattedCipherText, verboseMode);
 }
 
 /**
@@ -339,7 +581,8 @@ breakEncryption(const nGramScorer &n1, nGramScorer n2, int n, int rangeStart, in
  * @param aggressive Whether to use aggressive mode.
  * @param accommodateShortKey Whether to accommodate short keys.
  * @param multithread Whether to execute the function in multi-threaded mode.
- * @return The total time taken to execute the function.
+ * @return The total time taken to execute the function, which is bounded by the time budget in
+ * anytime mode.
  */
 double totalTimeTaken(std::chrono::time_point<std::chrono::high_resolution_clock> startTime,
                const std::function<void(const nGramScorer&, const nGramScorer&, int, int, int, const string&, const string&, const string&,
@@ -348,6 +591,7 @@ double totalTimeTaken(std::chrono::time_point<std::chrono::high_resolution_clock
                const string &alphabet, const string &originalCipherText,
                const string &formattedCipherText, bool verboseMode, bool aggressive, bool accommodateShortKey,
                bool multithread) {
+    searchBudget::start();
     if (multithread) {
         std::thread thread1(breakEncryption, std::ref(n1), std::ref(n2), n, rangeStart, rangeEnd, std::ref(alphabet), std::ref(originalCipherText),
                             std::ref(formattedCipherText), verboseMode, aggressive, accommodateShortKey, multithread);
@@ -362,11 +606,305 @@ double totalTimeTaken(std::chrono::time_point<std::chrono::high_resolution_clock
         breakEncryption(n1, n2, n, rangeStart, rangeEnd, alphabet, originalCipherText, formattedCipherText,
                         verboseMode, aggressive, accommodateShortKey, false);
     }
+    searchBudget::stop();
+    if (searchBudget::isEnabled()) {
+        printAnytimeResults(originalCipherText, formattedCipherText);
+    }
+    auto endTime = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::ratio<1>> elapsedTime = endTime - startTime;
+    return elapsedTime.count();
+}
+
+/**
+ * The number of best key prefixes each shard worker keeps for every work unit. The merge completes
+ * only the best prefix of each key length, as breakEncryption() does, so one is enough.
+ */
+const int shardTopK = 1;
+
+/**
+ * Keeps only the shardTopK highest scoring results, ordered by descending score. Ties keep the
+ * lowest prefix permutation, matching firstNKeyLetters().
+ * @param results the results to trim
+ */
+void keepTopResults(std::vector<shardResult> &results) {
+    auto middle = results.begin() + std::min((int) results.size(), shardTopK);
+    std::partial_sort(results.begin(), middle, results.end(), [](const shardResult &a, const shardResult &b) {
+        return a.score != b.score ? a.score > b.score : a.prefixIndex < b.prefixIndex;
+    });
+    results.erase(middle, results.end());
+}
+
+/**
+ * Scores the key prefixes of every work unit assigned to a worker and writes the best prefix of
+ * each unit to a file
+ * @param n1 an nGramScorer object
+ * @param n the number of characters making up the ngram
+ * @param alphabet the English alphabet
+ * @param formattedCipherText all-caps ciphertext with spaces and punctuation removed
+ * @param plan the shard plan shared by all workers
+ * @param workerIndex the index of this worker, from 0 to workers - 1
+ * @param workers the total number of workers
+ * @param outputPath the file to write the partial results to
+ * @return true if the partial results were written successfully
+ */
+bool runShardWorker(const nGramScorer &n1, int n, const string &alphabet, const string &formattedCipherText,
+                    const shardPlan &plan, int workerIndex, int workers, const string &outputPath) {
+    std::vector<shardResult> results;
+    for (int unit = 0; unit < plan.getUnitCount(); unit++) {
+        if (!shardPlan::isAssigned(unit, workerIndex, workers)) {
+            continue;
+        }
+        std::vector<shardResult> unitResults;
+        unitResults.reserve(plan.getPrefixEnd(unit) - plan.getPrefixStart(unit));
+        for (int i = plan.getPrefixStart(unit); i < plan.getPrefixEnd(unit); i++) {
+            unitResults.push_back({unit, i, prefixScore(n1, n, alphabet, formattedCipherText, plan.getKeyLength(unit), i)});
+        }
+        keepTopResults(unitResults);
+        results.insert(results.end(), unitResults.begin(), unitResults.end());
+    }
+    return plan.writeResults(outputPath, results);
+}
+
+/**
+ * Merges the partial results written by shard workers and completes the best prefix of each key
+ * length, giving the same key as breakEncryption() would in a single run.
+ * @param n2 an nGramScorer object
+ * @param n the number of characters making up the ngram
+ * @param rangeStart the minimum key length to try
+ * @param rangeEnd the maximum key length to try
+ * @param alphabet the English alphabet
+ * @param originalCipherText the ciphertext with spaces, punctuation, and non-alphabetic characters
+ * @param formattedCipherText all-caps ciphertext with spaces and punctuation removed
+ * @param plan the shard plan shared by all workers
+ * @param paths the files written by the workers
+ * @param verboseMode specify whether or not to use verbose mode
+ * @return false, after printing an error message, if a file cannot be read or a work unit is missing
+ */
+bool mergeShardResults(const nGramScorer &n2, int n, int rangeStart, int rangeEnd, const string &alphabet,
+                       const string &originalCipherText, const string &formattedCipherText, const shardPlan &plan,
+                       const std::vector<string> &paths, bool verboseMode) {
+    // A unit may appear in more than one file if workers were rerun by hand, so each unit is taken
+    // from the first file that contains it
+    std::vector<int> unitSource(plan.getUnitCount(), -1);
+    std::vector<std::vector<shardResult>> keyLengthResults(std::max(0, rangeEnd - rangeStart + 1));
+    for (int i = 0; i < (int) paths.size(); i++) {
+        std::vector<shardResult> fileResults;
+        if (!plan.readResults(paths[i], fileResults)) {
+            std::cerr << "Error: " << paths[i] << " could not be read or was written for a different search.\n";
+            return false;
+        }
+        for (const shardResult &result : fileResults) {
+            if (unitSource[result.unit] == -1) {
+                unitSource[result.unit] = i;
+            }
+            if (unitSource[result.unit] == i) {
+                keyLengthResults[plan.getKeyLength(result.unit) - rangeStart].push_back(result);
+            }
+        }
+    }
+    int missingUnits = (int) std::count(unitSource.begin(), unitSource.end(), -1);
+    if (missingUnits > 0) {
+        std::cerr << "Error: " << missingUnits << " of " << plan.getUnitCount()
+                  << " work units are missing from the shard files.\n";
+        return false;
+    }
+    std::vector<std::pair<double, string>> keyCandidates;
+    for (int tryKeyLength = rangeStart; tryKeyLength <= rangeEnd; tryKeyLength++) {
+        std::vector<shardResult> &results = keyLengthResults[tryKeyLength - rangeStart];
+        keepTopResults(results);
+        string keyBuilder = ngramPermutation(n, results[0].prefixIndex, alphabet);
+        string tryKey = fullKeyNormal(n2, n, alphabet, formattedCipherText, tryKeyLength, keyBuilder);
+        double bestScore = n2.score(
+                vigenereCipher::decrypt(formattedCipherText, vigenereCipher::formatKey(formattedCipherText, tryKey)));
+        keyCandidates.push_back(std::make_pair(bestScore, tryKey));
+        verboseMode ? printVerboseResults(bestScore, tryKeyLength, tryKey, originalCipherText, formattedCipherText) : (void)0;
+    }
+    reportBestKey(keyCandidates, originalCipherText, formattedCipherText, verboseMode);
+    return true;
+}
+
+/**
+ * Starts shard workers as child processes, waits for them to finish, and merges their partial
+ * results. The partial result files are created with mkstemp in the system's temporary directory and removed
+ * once merged, or before exiting the program if a worker or the merge fails.
+ * @param n1 an nGramScorer object
+ * @param n2 an nGramScorer object
+ * @param n the number of characters making up the ngram
+ * @param rangeStart the minimum key length to try
+ * @param rangeEnd the maximum key length to try
+ * @param alphabet the English alphabet
+ * @param originalCipherText the ciphertext with spaces, punctuation, and non-alphabetic characters
+ * @param formattedCipherText all-caps ciphertext with spaces and punctuation removed
+ * @param plan the shard plan shared by all workers
+ * @param workers the number of worker processes to start
+ * @param verboseMode specify whether or not to use verbose mode
+ */
+void runShardCoordinator(const nGramScorer &n1, const nGramScorer &n2, int n, int rangeStart, int rangeEnd,
+                         const string &alphabet, const string &originalCipherText, const string &formattedCipherText,
+                         const shardPlan &plan, int workers, bool verboseMode) {
+    std::vector<string> paths;
+    std::vector<pid_t> children;
+    bool workersSucceeded = true;
+    // Flush before forking so that buffered output is not repeated by the children
+    cout << std::flush;
+    for (int i = 0; i < workers && workersSucceeded; i++) {
+        // Create the file with mkstemp so that its name cannot be guessed and replaced (e.g. with a
+        // symlink) in the shared temporary directory before the worker writes to it
+        string path = (std::filesystem::temp_directory_path() / "vigenereCipherBreaker-XXXXXX").string();
+        int fd = mkstemp(&path[0]);
+        if (fd < 0) {
+            std::cerr << "Error: could not create a file for shard worker " << i << ".\n";
+            workersSucceeded = false;
+            break;
+        }
+        close(fd);
+        paths.push_back(path);
+        pid_t child = fork();
+        if (child == 0) {
+            bool written = runShardWorker(n1, n, alphabet, formattedCipherText, plan, i, workers, paths.back());
+            _exit(written ? EXIT_SUCCESS : EXIT_FAILURE);
+        }
+        if (child < 0) {
+            std::cerr << "Error: could not start shard worker " << i << ".\n";
+            workersSucceeded = false;
+        } else {
+            children.push_back(child);
+        }
+    }
+    for (pid_t child : children) {
+        int status = 0;
+        waitpid(child, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+            std::cerr << "Error: shard worker process " << child << " failed.\n";
+            workersSucceeded = false;
+        }
+    }
+    bool merged = workersSucceeded && mergeShardResults(n2, n, rangeStart, rangeEnd, alphabet, originalCipherText,
+                                                        formattedCipherText, plan, paths, verboseMode);
+    for (const string &path : paths) {
+        std::error_code error;
+        std::filesystem::remove(path, error);
+    }
+    if (!merged) {
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * This function runs one of the shard commands, which split a search over a range of key lengths
+ * across several processes. The commands are:
+ *
+ * --shard [ciphertext] [min keylength] [max keylength] [verbose mode] [workers] [slices]
+ *     starts the workers locally and merges their results
+ * --shard-worker [ciphertext] [min keylength] [max keylength] [slices] [workers] [worker index] [output file]
+ *     searches the work units assigned to one worker and writes the partial results to a file
+ * --shard-merge [ciphertext] [min keylength] [max keylength] [verbose mode] [slices] [shard files...]
+ *     merges the partial results written by the workers
+ *
+ * Every key length is split into [slices] parts of the key prefix candidate space. If the arguments
+ * are invalid, it prints an error message and exits the program with a failure code.
+ *
+ * @param argc The number of command line arguments.
+ * @param argv An array of strings containing the command line arguments.
+ * @param n1 An n-gram scorer for the key prefixes.
+ * @param n2 An n-gram scorer for the full keys.
+ * @param n The length of the n-grams used to score the key prefixes.
+ * @return The total time taken to run the command.
+ */
+double runShardCommand(int argc, char *argv[], const nGramScorer &n1, const nGramScorer &n2, int n) {
+    string command = argv[1];
+    bool validArgs = (command == "--shard" && argc == 8) || (command == "--shard-worker" && argc == 9) ||
+                     (command == "--shard-merge" && argc >= 8);
+    if (!validArgs) {
+        std::cerr << "Error: invalid shard command. Please use one of the following:\n"
+                  << "./vigenereCipherBreaker --shard [ciphertext] [min keylength] [max keylength] [verbose mode] [workers] [slices]\n"
+                  << "./vigenereCipherBreaker --shard-worker [ciphertext] [min keylength] [max keylength] [slices] [workers] [worker index] [output file]\n"
+                  << "./vigenereCipherBreaker --shard-merge [ciphertext] [min keylength] [max keylength] [verbose mode] [slices] [shard files...]\n";
+        exit(EXIT_FAILURE);
+    }
+    auto startTime = std::chrono::high_resolution_clock::now();
+    string originalCipherText = argv[2];
+    string formattedCipherText = formatCiphertext(originalCipherText);
+    string alphabet = theAlphabet();
+    int rangeStart = std::stoi(argv[3]);
+    int rangeEnd = std::stoi(argv[4]);
+    if (rangeStart < n || rangeEnd < rangeStart) {
+        std::cerr << "Error: the key length range must be at least " << n << " and in ascending order.\n";
+        exit(EXIT_FAILURE);
+    }
+    if (command == "--shard-worker") {
+        int workers = std::stoi(argv[6]);
+        int workerIndex = std::stoi(argv[7]);
+        if (workers < 1 || workerIndex < 0 || workerIndex >= workers) {
+            std::cerr << "Error: the worker index must be between 0 and the number of workers minus 1.\n";
+            exit(EXIT_FAILURE);
+        }
+        shardPlan plan(formattedCipherText, rangeStart, rangeEnd, n, std::stoi(argv[5]));
+        if (!runShardWorker(n1, n, alphabet, formattedCipherText, plan, workerIndex, workers, argv[8])) {
+            std::cerr << "Error: could not write " << argv[8] << ".\n";
+            exit(EXIT_FAILURE);
+        }
+    } else {
+        bool verboseMode = strcmp(argv[5], "0") != 0;
+        int slices = std::stoi(command == "--shard" ? argv[7] : argv[6]);
+        shardPlan plan(formattedCipherText, rangeStart, rangeEnd, n, slices);
+        cout << "\nATTEMPTING TO BREAK THE ENCRYPTION AND UNLOCK THE MESSAGE...\n\n";
+        if (command == "--shard") {
+            int workers = std::max(1, std::stoi(argv[6]));
+            runShardCoordinator(n1, n2, n, rangeStart, rangeEnd, alphabet, originalCipherText, formattedCipherText,
+                                plan, workers, verboseMode);
+        } else {
+            std::vector<string> paths(argv + 7, argv + argc);
+            if (!mergeShardResults(n2, n, rangeStart, rangeEnd, alphabet, originalCipherText, formattedCipherText,
+                                   plan, paths, verboseMode)) {
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
     auto endTime = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double, std::ratio<1>> elapsedTime = endTime - startTime;
     return elapsedTime.count();
 }
 
+/**
+ * Times fullKeyNormal() with the batched key letter scoring against the letter-by-letter loop for
+ * each key length in a range, and checks that both give the same key
+ * @param n1 an nGramScorer object used to find the first letters of the key
+ * @param n2 an nGramScorer object used to complete the key
+ * @param n the number of characters making up the ngram
+ * @param rangeStart the minimum key length to try
+ * @param rangeEnd the maximum key length to try
+ * @param alphabet the English alphabet
+ * @param formattedCipherText all-caps ciphertext with spaces and punctuation removed
+ * @param repetitions the number of times to complete each key with each method
+ */
+void runBenchmark(const nGramScorer &n1, const nGramScorer &n2, int n, int rangeStart, int rangeEnd,
+                  const string &alphabet, const string &formattedCipherText, int repetitions) {
+    double totalLoopTime = 0;
+    double totalBatchedTime = 0;
+    cout << "\nKey length | Loop (ms) | Batched (ms) | Speedup | Same key\n";
+    for (int tryKeyLength = rangeStart; tryKeyLength <= rangeEnd; tryKeyLength++) {
+        string keyBuilder = firstNKeyLetters(n1, n, alphabet, formattedCipherText, tryKeyLength);
+        string keys[2];
+        double times[2];
+        for (int batched = 0; batched < 2; batched++) {
+            auto startTime = std::chrono::high_resolution_clock::now();
+            for (int i = 0; i < repetitions; i++) {
+                keys[batched] = fullKeyNormal(n2, n, alphabet, formattedCipherText, tryKeyLength, keyBuilder, batched);
+            }
+            auto endTime = std::chrono::high_resolution_clock::now();
+            std::chrono::duration<double, std::milli> elapsedTime = endTime - startTime;
+            times[batched] = elapsedTime.count() / repetitions;
+        }
+        totalLoopTime += times[0];
+        totalBatchedTime += times[1];
+        printf("%10d | %9.3f | %12.3f | %6.1fx | %s\n", tryKeyLength, times[0], times[1], times[0] / times[1],
+               keys[0] == keys[1] ? "yes" : "NO");
+    }
+    printf("%10s | %9.3f | %12.3f | %6.1fx |\n\n", "Total", totalLoopTime, totalBatchedTime,
+           totalLoopTime / totalBatchedTime);
+}
+
 /**
  * 
  * This function processes the command line arguments passed to the program and stores the values in the 
@@ -381,13 +919,14 @@ double totalTimeTaken(std::chrono::time_point<std::chrono::high_resolution_clock
  * @param rangeStart An integer to store the start of the range of key lengths to try.
  * @param rangeEnd An integer to store the end of the range of key lengths to try.
  * @param verboseMode A boolean to store whether verbose mode is enabled.
+ * @param timeBudget A double to store the time budget in seconds for each attempt (0 if none was given).
  */
 void processCommandLineArgs(int argc, char *argv[], string& originalCipherText, string& formattedCipherText, 
-                            string& alphabet, int& rangeStart, int& rangeEnd, bool& verboseMode) {
+                            string& alphabet, int& rangeStart, int& rangeEnd, bool& verboseMode, double& timeBudget) {
     // Check if the correct number of command line arguments were provided
-    if (argc != 5) {
+    if (argc != 5 && argc != 6) {
         std::cerr << "Error: invalid number of command line arguments. Please use the following syntax:\n"
-                  << "./vigenereCipherBreaker [ciphertext] [min keylength] [max keylength] [verbose mode]\n"
+                  << "./vigenereCipherBreaker [ciphertext] [min keylength] [max keylength] [verbose mode] [time budget (optional)]\n"
                   << "Example: ./vigenereCipherBreaker \"Uvagxhvrshdm, fu uvagxhaoyq, eg kkw ttrgmxcw sjr jwmha fj mtczfeelhk jqi wxrujw ycdpmrktemxof aj hyh hvgjigre gx pvzuv tcixbts.\" 4 20 0\n";
         exit(EXIT_FAILURE);
     }
@@ -399,6 +938,7 @@ void processCommandLineArgs(int argc, char *argv[], string& originalCipherText,
     rangeStart = std::stoi(argv[2]);
     rangeEnd = std::stoi(argv[3]);
     verboseMode = strcmp(argv[4], "0") != 0;
+    timeBudget = (argc == 6) ? std::stod(argv[5]) : 0;
 }
 
 /** 
@@ -437,15 +977,33 @@ int main(int argc, char *argv[]) {
     nGramScorer trigram(std::ifstream(R"(ngrams/trigrams.txt)"));
     nGramScorer quadgram(std::ifstream(R"(ngrams/quadgrams.txt)"));
 
+    // Benchmark the batched key letter scoring against the letter-by-letter loop
+    if (argc == 5 && strcmp(argv[1], "--benchmark") == 0) {
+        runBenchmark(trigram, quadgram, 3, std::stoi(argv[3]), std::stoi(argv[4]), theAlphabet(),
+                     formatCiphertext(argv[2]), 20);
+        return EXIT_SUCCESS;
+    }
+
+    // Shard commands run a single non-interactive attempt split across processes
+    if (argc > 1 && strncmp(argv[1], "--shard", 7) == 0) {
+        double timeTaken = runShardCommand(argc, argv, trigram, quadgram, 3);
+        printf("Total elapsed time for operation: %.2f seconds\n\n", timeTaken);
+        return EXIT_SUCCESS;
+    }
+
     // Read and process command line arguments
     string originalCipherText, formattedCipherText, alphabet;   
     int rangeStart, rangeEnd;
     bool verboseMode;
-    processCommandLineArgs(argc, argv, originalCipherText, formattedCipherText, alphabet, rangeStart, rangeEnd, verboseMode);
+    double timeBudget;
+    processCommandLineArgs(argc, argv, originalCipherText, formattedCipherText, alphabet, rangeStart, rangeEnd, verboseMode,
+                           timeBudget);
+    searchBudget::setTimeBudget(timeBudget);
     
-    // Determine if parallelization could be used
+    // Determine if parallelization could be used. Anytime mode reports a single result across all threads,
+    // so it does not need verbose mode to be on.
     int numCores = std::thread::hardware_concurrency();
-    bool multithread = (rangeEnd - rangeStart >= 10) && (verboseMode) && (numCores > 1);
+    bool multithread = (rangeEnd - rangeStart >= 10) && (verboseMode || searchBudget::isEnabled()) && (numCores > 1);
     
     double timeTaken = 0;
     string response{};
@@ -461,6 +1019,12 @@ int main(int argc, char *argv[]) {
                                               originalCipherText, formattedCipherText, verboseMode, false, false, multithread);
             response = getResponse();
             attempts[0] = true;
+        } else if (!attempts[1] && vigenereCipher::getKeyLength() == 0) {
+            // No key was scored before the time budget ran out or the search was cancelled, so there
+            // is no key length for the stronger attempts to work on
+            cout << "\nNo key length was found within the time budget. Try again with a larger budget.\n";
+            printf("\nTotal elapsed time for operation: %.2f seconds\n\n", timeTaken);
+            exhaustedAttempts = true;
         } else if (!attempts[1]) {
             int keyLength = vigenereCipher::getKeyLength(); // will be incorrect if multithread was on.
             bool accommodateShortKey = (keyLength < 12);